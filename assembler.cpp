@@ -0,0 +1,657 @@
+// assembler.cpp
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <set>
+#include <cstdlib>
+#include <cerrno>
+#include "assembler.h"
+#include "hexutil.h"
+#include "scanner.h"
+
+using namespace std;
+
+// Highest address a program may reach (addresses are written as 6 hex digits)
+const int maxAddress = 0xFFFFFF;
+
+// Run both passes, sending each output to its sink as soon as it is ready.
+// The symbol table is left in 'symtab' for the caller.
+void assemble(LineSource &input, const AssemblyOutputs &outputs, Symtab &symtab)
+{
+    Opcode opcodeTable;
+    vector<IntermediateLine> intermediateLines;
+    vector<string> sourceLines; // every line of the input, for the listing
+    vector<int> sourceIndex;    // source line of each intermediate line
+    int programLength = 0;
+
+    // Pass One: Build Symbol Table and Intermediate File
+    passOne(input, symtab, intermediateLines, programLength, opcodeTable, sourceLines, sourceIndex, outputs.intermediate);
+
+    // Write symbol table
+    outputs.symtab.write(symtab.formatTable());
+
+    // Pass Two: Generate Object Code and the Listing
+    Listing listing(outputs.listing, sourceLines);
+    passTwo(intermediateLines, symtab, opcodeTable, outputs.object, programLength, sourceIndex, listing);
+    listing.finish(symtab); // also when pass two stopped early
+
+    // Sorted symbol exports, including the use sites found in pass two
+    outputs.xref.write(symtab.formatSortedText());
+    outputs.symbolIndex.write(symtab.formatIndex());
+}
+
+void assembleBuffer(const string &source, AssemblyText &text, Symtab &symtab)
+{
+    BufferLines input(source);
+    StringSink intermediate(text.intermediate), symtabOut(text.symtab), object(text.object),
+        listing(text.listing), xref(text.xref), symbolIndex(text.symbolIndex);
+    assemble(input, {intermediate, symtabOut, object, listing, xref, symbolIndex}, symtab);
+}
+
+// Text of a line of the intermediate file: location, label, opcode and operand
+// separated by single spaces, so a missing label leaves two spaces
+string formatIntermediateLine(const IntermediateLine &entry)
+{
+    return entry.location + " " + entry.label + " " + entry.opcode + " " + entry.operand;
+}
+
+// Split a line into whitespace-separated tokens. A C'...' or X'...' constant
+// runs to its closing quote, so it stays one token even if it contains spaces.
+void tokenize(const string &line, vector<string> &tokens)
+{
+    tokens.clear();
+    const char *data = line.data();
+    size_t length = line.length();
+    size_t pos = scanSkipSpace(data, length);
+
+    while (pos < length)
+    {
+        size_t end = pos + scanFindSpace(data + pos, length - pos);
+        char type = toupper(static_cast<unsigned char>(data[pos]));
+        if ((type == 'C' || type == 'X') && pos + 1 < length && data[pos + 1] == '\'')
+        {
+            size_t quote = pos + 2 + scanFindChar(data + pos + 2, length - pos - 2, '\'');
+            if (quote < length && quote >= end)
+            {
+                end = quote + 1;
+                end += scanFindSpace(data + end, length - end);
+            }
+        }
+
+        tokens.emplace_back(data + pos, end - pos);
+        pos = end + scanSkipSpace(data + end, length - end);
+    }
+}
+
+// Separate function to parse a line into label, opcode, and operand
+void separate(const string &line, string &label, string &opcode, string &operand, const Opcode &opcodeTable)
+{
+    vector<string> tokens;
+    tokenize(line, tokens);
+
+    label = "";
+    opcode = "";
+    operand = "";
+
+    if (tokens.empty())
+    {
+        return;
+    }
+
+    // If the first character is not whitespace, assume the first token is a label,
+    // unless it is an opcode or directive that was simply not indented
+    bool hasLabel = !isspace(static_cast<unsigned char>(line[0]));
+    if (hasLabel && (opcodeTable.isOpcode(tokens[0]) || isAssemblerDirective(tokens[0])))
+    {
+        hasLabel = tokens.size() >= 2 && (opcodeTable.isOpcode(tokens[1]) || isAssemblerDirective(tokens[1]));
+    }
+
+    if (hasLabel)
+    {
+        if (tokens.size() >= 3)
+        {
+            label = tokens[0];
+            opcode = tokens[1];
+            operand = tokens[2];
+        }
+        else if (tokens.size() == 2)
+        {
+            label = tokens[0];
+            opcode = tokens[1];
+        }
+        else if (tokens.size() == 1)
+        {
+            label = tokens[0];
+        }
+    }
+    // Line has no label
+    else
+    {
+        if (tokens.size() >= 2)
+        {
+            opcode = tokens[0];
+            operand = tokens[1];
+        }
+        else if (tokens.size() == 1)
+        {
+            opcode = tokens[0];
+        }
+    }
+}
+
+// Check if a string is an assembler directive
+bool isAssemblerDirective(const string &str)
+{
+    static const set<string> directives = {
+        "START", "END", "WORD", "RESW", "RESB", "BYTE", "BASE", "NOBASE", "EQU"};
+    string upperStr = str;
+    transform(upperStr.begin(), upperStr.end(), upperStr.begin(), ::toupper);
+    return directives.find(upperStr) != directives.end();
+}
+
+// Parse a whole operand as a number in the given base; unlike stoi this never
+// throws and rejects trailing garbage and values outside [minValue, maxValue]
+bool parseNumber(const string &str, int base, int minValue, int maxValue, int &value)
+{
+    if (str.empty() || isspace(static_cast<unsigned char>(str[0])))
+        return false;
+
+    char *end = nullptr;
+    errno = 0;
+    long result = strtol(str.c_str(), &end, base);
+    if (errno != 0 || *end != '\0' || result < minValue || result > maxValue)
+        return false;
+
+    value = static_cast<int>(result);
+    return true;
+}
+
+// Decode a BYTE operand, C'...' or X'...', into its object code (two hex digits per byte)
+bool parseByteConstant(const string &operand, string &objCode)
+{
+    objCode = "";
+    if (operand.length() < 3 || operand[1] != '\'' || operand.back() != '\'')
+        return false;
+
+    const char *body = operand.data() + 2;
+    size_t bodyLength = operand.length() - 3;
+    char type = toupper(static_cast<unsigned char>(operand[0]));
+    if (type == 'C')
+    {
+        // Character constant
+        bytesToHex(body, bodyLength, objCode);
+        return bodyLength > 0;
+    }
+    if (type == 'X')
+    {
+        // Hex constant: an even number of hex digits
+        if (bodyLength == 0 || bodyLength % 2 != 0)
+            return false;
+        return normalizeHex(body, bodyLength, objCode);
+    }
+    return false;
+}
+
+void passOne(LineSource &input, Symtab &symtab,
+             vector<IntermediateLine> &intermediateLines, int &programLength, Opcode &opcodeTable,
+             vector<string> &sourceLines, vector<int> &sourceIndex, TextSink &intermediateOut)
+{
+    string line;
+    int locctr = 0;
+    int startAddress = 0;
+    bool started = false;
+    bool ended = false;
+
+    while (input.next(line))
+    {
+        sourceLines.push_back(line);
+        int lineIndex = static_cast<int>(sourceLines.size()) - 1;
+
+        // Lines after END are kept for the listing but not assembled
+        if (ended || line.empty() || line[0] == '.')
+        {
+            continue;
+        }
+
+        string label, opcode, operand;
+        string currentLoc = intToHex(locctr, 6);
+
+        // Parse the line
+        separate(line, label, opcode, operand, opcodeTable);
+        cout << "Processing Line: " << line << endl;
+        cout << "Label: " << label << ", Opcode: " << opcode << ", Operand: " << operand << endl;
+
+        transform(opcode.begin(), opcode.end(), opcode.begin(), ::toupper);
+
+        if (opcode == "START")
+        {
+            if (!started)
+            {
+                if (!parseNumber(operand, 16, 0, maxAddress, startAddress))
+                {
+                    cerr << "Error: Invalid start address " << operand << " in line: " << line << endl;
+                    startAddress = 0;
+                }
+                locctr = startAddress;
+                started = true;
+                intermediateLines.push_back({currentLoc, label, opcode, operand});
+                intermediateOut.write(formatIntermediateLine(intermediateLines.back()) + "\n");
+                sourceIndex.push_back(lineIndex);
+                continue;
+            }
+        }
+
+        if (!started)
+        {
+            startAddress = 0;
+            locctr = 0;
+            started = true;
+        }
+
+        // Add label to symbol table if present
+        if (!label.empty())
+        {
+            if (symtab.contains(label))
+            {
+                cerr << "Error: Duplicate symbol " << label << endl;
+            }
+            else
+            {
+                symtab.addSymbol(label, locctr, lineIndex + 1);
+            }
+        }
+
+        // Create intermediate line
+        intermediateLines.push_back({currentLoc, label, opcode, operand});
+        intermediateOut.write(formatIntermediateLine(intermediateLines.back()) + "\n");
+        sourceIndex.push_back(lineIndex);
+
+        // Update location counter based on instruction type
+        int size = 0;
+        if (opcode == "END")
+        {
+            ended = true;
+        }
+        else if (opcodeTable.isOpcode(opcode))
+        {
+            size = 3;
+        }
+        else if (opcode == "WORD")
+        {
+            size = 3;
+        }
+        else if (opcode == "RESW" || opcode == "RESB")
+        {
+            int count = 0;
+            int unit = (opcode == "RESW") ? 3 : 1;
+            if (parseNumber(operand, 10, 0, maxAddress, count))
+            {
+                size = unit * count;
+            }
+            else
+            {
+                cerr << "Error: Invalid " << opcode << " operand " << operand << " in line: " << line << endl;
+            }
+        }
+        else if (opcode == "BYTE")
+        {
+            string objCode;
+            if (parseByteConstant(operand, objCode))
+            {
+                size = static_cast<int>(objCode.length() / 2); // Two hex digits = 1 byte
+            }
+            else
+            {
+                cerr << "Error: Invalid BYTE constant " << operand << " in line: " << line << endl;
+            }
+        }
+        else if (!isAssemblerDirective(opcode))
+        {
+            cerr << "Error: Invalid opcode " << opcode << " in line: " << line << endl;
+        }
+
+        // Every address, including the one after the last byte, must fit in 6 hex digits
+        if (size > maxAddress - locctr)
+        {
+            cerr << "Error: Program exceeds addressable memory in line: " << line << endl;
+        }
+        else
+        {
+            locctr += size;
+        }
+    }
+
+    programLength = locctr - startAddress;
+}
+
+void passTwo(const vector<IntermediateLine> &intermediateLines, Symtab &symtab,
+             const Opcode &opcodeTable, TextSink &output, int programLength,
+             const vector<int> &sourceIndex, Listing &listing)
+{
+    // Records are handed to the output as soon as they are complete
+    string headerRecord, endRecord;
+    int startAddress = 0;
+
+    // Ensure there is at least one line for the header
+    if (intermediateLines.empty())
+    {
+        cerr << "Error: Intermediate file is empty." << endl;
+        return;
+    }
+
+    // Header Record comes from intermediateLines[0]
+    const string &locctrStr = intermediateLines[0].location;
+    const string &label = intermediateLines[0].label;
+    const string &opcodeStr = intermediateLines[0].opcode;
+    const string &operand = intermediateLines[0].operand;
+
+    // Header Record Construction
+    string programName = label.empty() ? "      " : label;
+    if (programName.length() < 6)
+        programName += string(6 - programName.length(), ' ');
+    else if (programName.length() > 6)
+        programName = programName.substr(0, 6);
+
+    if (opcodeStr == "START")
+    {
+        // Operand is starting address in hex; pass one already reported a bad one
+        if (!parseNumber(operand, 16, 0, maxAddress, startAddress))
+            startAddress = 0;
+    }
+    else
+    {
+        startAddress = 0;
+    }
+
+    // START is recorded before the location counter is set, so list it at the start address
+    listing.beginLine(sourceIndex[0], opcodeStr == "START" ? intToHex(startAddress, 6) : locctrStr);
+
+    // Create Header Record
+    headerRecord = "H " + programName + " " + intToHex(startAddress, 6) + " " + intToHex(programLength, 6);
+    output.write(headerRecord + "\n");
+
+    // Initialize Text Records
+    string currentTextAddress = "";
+    vector<string> currentObjectCodes; // Stores object codes
+    int currentRecordLength = 0;       // in bytes
+    endRecord = "";                    // Initialize endRecord
+
+    // Iterate through intermediateLines starting from the second line
+    for (size_t i = 1; i < intermediateLines.size(); ++i)
+    {
+        const IntermediateLine &entry = intermediateLines[i];
+        const string &currLocctrStr = entry.location;
+        const string &opcodeField = entry.opcode;
+        const string &operandField = entry.operand;
+
+        // Listing entry for this line; object code is filled in below
+        int lineNo = sourceIndex[i] + 1;
+        listing.beginLine(sourceIndex[i], currLocctrStr);
+
+        // Handle assembler directives
+        if (isAssemblerDirective(opcodeField))
+        {
+            if (opcodeField == "END")
+            {
+                // Determine execution address
+                string execAddress = "";
+                if (!operandField.empty())
+                {
+                    if (symtab.contains(operandField))
+                    {
+                        symtab.addReference(operandField, lineNo);
+                        execAddress = intToHex(symtab.getAddress(operandField), 6);
+                    }
+                    else
+                    {
+                        // If operand not found, default to startAddress
+                        execAddress = intToHex(startAddress, 6);
+                    }
+                }
+                else
+                {
+                    execAddress = intToHex(startAddress, 6);
+                }
+
+                // Store End Record to write later
+                endRecord = "E " + execAddress;
+                // Continue processing without writing
+                continue;
+            }
+            else if (opcodeField == "WORD")
+            {
+                // Convert operand to object code
+                int value = 0;
+                if (!parseNumber(operandField, 10, -0x800000, 0xFFFFFF, value))
+                {
+                    cerr << "Error: Invalid WORD operand " << operandField << " in line: " << formatIntermediateLine(entry) << endl;
+                }
+                string objCode = intToHex(value & 0xFFFFFF, 6); // 24-bit two's complement
+                listing.setObjectCode(objCode);
+
+                // Add to text records
+                if (currentObjectCodes.empty())
+                {
+                    currentTextAddress = currLocctrStr;
+                }
+                if (currentRecordLength + 3 > 30)
+                {
+                    // Flush current text record
+                    string textRecord = "T " + currentTextAddress + " " + intToHex(currentRecordLength, 2);
+                    for (const auto &obj : currentObjectCodes)
+                    {
+                        textRecord += " " + obj;
+                    }
+                    output.write(textRecord + "\n");
+
+                    // Start new text record
+                    currentTextAddress = currLocctrStr;
+                    currentObjectCodes.clear();
+                }
+
+                currentObjectCodes.push_back(objCode);
+                currentRecordLength += 3;
+            }
+            else if (opcodeField == "BYTE")
+            {
+                // Handle BYTE directive
+                // Pass one already reported a malformed constant; it generates no code
+                string objCode;
+                parseByteConstant(operandField, objCode);
+                listing.setObjectCode(objCode);
+
+                // Group into 6-character chunks (3 bytes)
+                for (size_t j = 0; j < objCode.length(); j += 6)
+                {
+                    string group = objCode.substr(j, 6);
+                    // Pad with zeros if necessary
+                    while (group.length() < 6)
+                        group += '0';
+
+                    // Check if we need to start a new text record
+                    if (currentObjectCodes.empty())
+                    {
+                        currentTextAddress = currLocctrStr;
+                    }
+
+                    if (currentRecordLength + 3 > 30)
+                    {
+                        // Flush current text record
+                        string textRecord = "T " + currentTextAddress + " " + intToHex(currentRecordLength, 2);
+                        for (const auto &obj : currentObjectCodes)
+                        {
+                            textRecord += " " + obj;
+                        }
+                        output.write(textRecord + "\n");
+
+                        // Start new text record
+                        currentTextAddress = currLocctrStr;
+                        currentObjectCodes.clear();
+                        currentObjectCodes.push_back(group);
+                        currentRecordLength = 3;
+                    }
+                    else
+                    {
+                        currentObjectCodes.push_back(group);
+                        currentRecordLength += 3;
+                    }
+                }
+            }
+            else if (opcodeField == "RESW" || opcodeField == "RESB")
+            {
+                // RESW and RESB do not generate object code
+                // Flush current text record if any
+                if (!currentObjectCodes.empty())
+                {
+                    string textRecord = "T " + currentTextAddress + " " + intToHex(currentRecordLength, 2);
+                    for (const auto &obj : currentObjectCodes)
+                    {
+                        textRecord += " " + obj;
+                    }
+                    output.write(textRecord + "\n");
+                    currentObjectCodes.clear();
+                    currentRecordLength = 0;
+                }
+            }
+            else
+            {
+                cerr << "Error: Unsupported directive " << opcodeField << " in line: " << formatIntermediateLine(entry) << endl;
+            }
+        }
+        else
+        {
+            // It's a machine instruction opcode
+            if (!opcodeTable.isOpcode(opcodeField))
+            {
+                cerr << "Error: Invalid opcode " << opcodeField << " in line: " << formatIntermediateLine(entry) << endl;
+                continue; // Skip to next line
+            }
+
+            // Generate object code
+            string machineCode = opcodeTable.getMachineCode(opcodeField);
+            string objCode = "";
+
+            if (machineCode.empty())
+            {
+                cerr << "Error: No machine code for opcode " << opcodeField << endl;
+                continue; // Skip to next line
+            }
+
+            if (opcodeField == "RSUB")
+            {
+                // RSUB has no operand, fixed object code
+                objCode = machineCode + "0000";
+            }
+            else
+            {
+                // Handle operands
+                // Check for immediate addressing or indexed addressing
+                bool isImmediate = false;
+                bool isIndexed = false;
+                string symbol = operandField;
+                if (!operandField.empty())
+                {
+                    if (operandField[0] == '#')
+                    {
+                        isImmediate = true;
+                        symbol = operandField.substr(1);
+                    }
+                    if (operandField.find(",X") != string::npos || operandField.find(",x") != string::npos)
+                    {
+                        isIndexed = true;
+                        symbol = operandField.substr(0, operandField.find(","));
+                    }
+                }
+
+                // Lookup symbol address
+                int address = 0;
+                if (!symbol.empty())
+                {
+                    if (symtab.contains(symbol))
+                    {
+                        symtab.addReference(symbol, lineNo);
+                        address = symtab.getAddress(symbol);
+                    }
+                    else
+                    {
+                        cerr << "Error: Undefined symbol " << symbol << " in line: " << formatIntermediateLine(entry) << endl;
+                        address = 0; // Or handle error appropriately
+                    }
+                }
+
+                // Construct address with flags
+                if (isImmediate)
+                {
+                    // Immediate addressing: no flags set
+                    objCode = machineCode + intToHex(address, 4);
+                }
+                else
+                {
+                    // Direct addressing
+                    if (isIndexed)
+                    {
+                        // Set indexed flag (bit 0)
+                        // Assuming 16-bit address and indexed flag is the highest bit
+                        address += 0x8000;
+                    }
+                    objCode = machineCode + intToHex(address, 4);
+                }
+            }
+
+            // Ensure object code is exactly 6 hex digits
+            if (objCode.length() < 6)
+                objCode = string(6 - objCode.length(), '0') + objCode;
+            else if (objCode.length() > 6)
+                objCode = objCode.substr(0, 6);
+            listing.setObjectCode(objCode);
+
+            // Add to text records
+            if (currentObjectCodes.empty())
+            {
+                currentTextAddress = currLocctrStr;
+            }
+
+            if (currentRecordLength + 3 > 30) // Max 30 bytes per text record
+            {
+                // Flush current text record
+                string textRecord = "T " + currentTextAddress + " " + intToHex(currentRecordLength, 2);
+                for (const auto &obj : currentObjectCodes)
+                {
+                    textRecord += " " + obj;
+                }
+                output.write(textRecord + "\n");
+
+                // Start new text record
+                currentTextAddress = currLocctrStr;
+                currentObjectCodes.clear();
+                currentObjectCodes.push_back(objCode);
+                currentRecordLength = 3;
+            }
+            else
+            {
+                currentObjectCodes.push_back(objCode);
+                currentRecordLength += 3;
+            }
+        }
+    }
+
+    // After processing all lines, flush any remaining text record
+    if (!currentObjectCodes.empty())
+    {
+        string textRecord = "T " + currentTextAddress + " " + intToHex(currentRecordLength, 2);
+        for (const auto &obj : currentObjectCodes)
+        {
+            textRecord += " " + obj;
+        }
+        output.write(textRecord + "\n");
+    }
+
+    // Write the End Record after all Text Records
+    if (!endRecord.empty())
+    {
+        output.write(endRecord + "\n");
+    }
+}
+
+// pass two has been modified with a little help of chatGPT
\ No newline at end of file
@@ -0,0 +1,60 @@
+// assembler.h
+#ifndef ASSEMBLER_H
+#define ASSEMBLER_H
+
+#include <string>
+#include <vector>
+#include "opcode.h"
+#include "symtab.h"
+#include "listing.h"
+#include "pipeline.h"
+
+// Where each output of an assembly goes
+struct AssemblyOutputs
+{
+    TextSink &intermediate;
+    TextSink &symtab;
+    TextSink &object;
+    TextSink &listing;
+    TextSink &xref;
+    TextSink &symbolIndex;
+};
+
+// One statement as pass one parsed it, handed to pass two field by field
+struct IntermediateLine
+{
+    std::string location;
+    std::string label;
+    std::string opcode;
+    std::string operand;
+};
+
+// Contents of every output, when assembling a buffer in memory
+struct AssemblyText
+{
+    std::string intermediate;
+    std::string symtab;
+    std::string object;
+    std::string listing;
+    std::string xref;
+    std::string symbolIndex;
+};
+
+void assemble(LineSource &input, const AssemblyOutputs &outputs, Symtab &symtab);
+void assembleBuffer(const std::string &source, AssemblyText &text, Symtab &symtab);
+
+void passOne(LineSource &input, Symtab &symtab,
+             std::vector<IntermediateLine> &intermediateLines, int &programLength, Opcode &opcodeTable,
+             std::vector<std::string> &sourceLines, std::vector<int> &sourceIndex, TextSink &intermediateOut);
+void passTwo(const std::vector<IntermediateLine> &intermediateLines, Symtab &symtab,
+             const Opcode &opcodeTable, TextSink &output, int programLength,
+             const std::vector<int> &sourceIndex, Listing &listing);
+
+std::string formatIntermediateLine(const IntermediateLine &entry);
+void tokenize(const std::string &line, std::vector<std::string> &tokens);
+bool isAssemblerDirective(const std::string &str);
+void separate(const std::string &line, std::string &label, std::string &opcode, std::string &operand, const Opcode &opcodeTable);
+bool parseNumber(const std::string &str, int base, int minValue, int maxValue, int &value);
+bool parseByteConstant(const std::string &operand, std::string &objCode);
+
+#endif // ASSEMBLER_H
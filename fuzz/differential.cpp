@@ -0,0 +1,183 @@
+// differential.cpp
+#include "differential.h"
+#include "../assembler.h"
+#include "../scanner.h"
+#include "../symindex.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+// Silences the assembler's progress and error messages while it is alive
+class QuietOutput
+{
+public:
+    QuietOutput() : out(std::cout.rdbuf(nullptr)), err(std::cerr.rdbuf(nullptr)) {}
+    ~QuietOutput()
+    {
+        std::cout.rdbuf(out);
+        std::cerr.rdbuf(err);
+        std::cout.clear();
+        std::cerr.clear();
+    }
+
+private:
+    std::streambuf *out;
+    std::streambuf *err;
+};
+
+static bool compareOutput(const char *file, const std::string &expected, const std::string &actual,
+                          const std::string &level, std::string &mismatch)
+{
+    if (expected == actual)
+        return true;
+
+    size_t offset = 0;
+    while (offset < expected.size() && offset < actual.size() && expected[offset] == actual[offset])
+        ++offset;
+    mismatch = std::string(file) + " differs between scalar and " + level + " at byte " +
+               std::to_string(offset) + " (sizes " + std::to_string(expected.size()) + " and " +
+               std::to_string(actual.size()) + ")";
+    return false;
+}
+
+// Load the symbol index and look every symbol of the table up by name and by address
+static bool checkSymbolIndex(const std::string &bytes, const Symtab &symtab, std::string &mismatch)
+{
+    SymbolIndex index;
+    const std::vector<Symtab::SymbolEntry> &byName = symtab.sortedByName();
+    const std::vector<Symtab::SymbolEntry> &byAddress = symtab.sortedByAddress();
+    if (!index.loadBuffer(bytes, "symtab.idx") || index.size() != byName.size())
+    {
+        mismatch = "symtab.idx does not load, or does not hold " + std::to_string(byName.size()) + " symbols";
+        return false;
+    }
+
+    SymbolIndex::Symbol found;
+    for (const Symtab::SymbolEntry &entry : byName)
+    {
+        if (!index.findByName(*entry.name, found) || found.name != *entry.name || found.address != entry.address ||
+            found.definitionLine != entry.definitionLine || found.references != *entry.references)
+        {
+            mismatch = "symtab.idx lookup by name of " + *entry.name + " does not match the symbol table";
+            return false;
+        }
+
+        // Symbols sharing an address are found as the last of them in address order
+        unsigned int last = entry.addressIndex;
+        while (last + 1 < byAddress.size() && byAddress[last + 1].address == entry.address)
+            ++last;
+        if (!index.findByAddress(entry.address, found) || found.name != *byAddress[last].name ||
+            found.address != entry.address)
+        {
+            mismatch = "symtab.idx lookup by address of " + *entry.name + " does not match the symbol table";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool compareScannerLevels(const std::string &source, std::string &mismatch)
+{
+    const std::string previous = scannerLevel();
+    QuietOutput quiet;
+
+    AssemblyText reference;
+    Symtab symtab;
+    setScannerLevel("scalar");
+    assembleBuffer(source, reference, symtab);
+
+    bool same = checkSymbolIndex(reference.symbolIndex, symtab, mismatch);
+    for (const char *name : {"sse2", "avx2"})
+    {
+        if (!same)
+            break;
+        setScannerLevel(name);
+        std::string level = scannerLevel();
+        if (level == "scalar")
+            continue; // not supported on this CPU
+
+        AssemblyText fast;
+        Symtab fastSymtab;
+        assembleBuffer(source, fast, fastSymtab);
+        same = compareOutput("output.txt", reference.object, fast.object, level, mismatch) &&
+               compareOutput("intermediate.txt", reference.intermediate, fast.intermediate, level, mismatch) &&
+               compareOutput("symtab.txt", reference.symtab, fast.symtab, level, mismatch) &&
+               compareOutput("listing.txt", reference.listing, fast.listing, level, mismatch) &&
+               compareOutput("xref.txt", reference.xref, fast.xref, level, mismatch) &&
+               compareOutput("symtab.idx", reference.symbolIndex, fast.symbolIndex, level, mismatch);
+    }
+
+    setScannerLevel(previous.c_str());
+    return same;
+}
+
+// Read the file through a LineReader with the given block size and compare
+// its lines with the expected ones
+static bool compareLines(const char *path, const std::vector<std::string> &expected, size_t blockSize,
+                         const std::string &level, std::string &mismatch)
+{
+    LineReader reader(path, blockSize);
+    std::string line;
+    size_t count = 0;
+    while (reader.next(line))
+    {
+        if (count == expected.size() || line != expected[count])
+            break;
+        ++count;
+    }
+    if (count == expected.size() && !reader.next(line))
+        return true;
+
+    mismatch = "LineReader with " + std::to_string(blockSize) + "-byte blocks and the " + level +
+               " scanner differs from BufferLines at line " + std::to_string(count + 1);
+    return false;
+}
+
+bool compareLineReader(const std::string &source, std::string &mismatch)
+{
+    char path[] = "/tmp/differential_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        mismatch = "cannot create a temporary file";
+        return false;
+    }
+    close(fd);
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << source;
+    }
+
+    std::vector<std::string> expected;
+    BufferLines lines(source);
+    std::string line;
+    while (lines.next(line))
+        expected.push_back(line);
+
+    const std::string previous = scannerLevel();
+    bool same = true;
+    for (const char *name : {"scalar", "sse2", "avx2"})
+    {
+        setScannerLevel(name);
+        std::string level = scannerLevel();
+        if (level != name)
+            continue; // not supported on this CPU
+
+        for (size_t blockSize : {1, 2, 7, 64, 4096})
+        {
+            if (!compareLines(path, expected, blockSize, level, mismatch))
+            {
+                same = false;
+                break;
+            }
+        }
+        if (!same)
+            break;
+    }
+
+    setScannerLevel(previous.c_str());
+    std::remove(path);
+    return same;
+}
@@ -0,0 +1,18 @@
+// differential.h
+#ifndef DIFFERENTIAL_H
+#define DIFFERENTIAL_H
+
+#include <string>
+
+// Assemble the source with the scalar reference scanner and again with each
+// vectorized level, entirely in memory, and compare every output byte for
+// byte. The symbol index is also checked against the symbol table it came
+// from. Returns false and describes the first difference in 'mismatch'.
+bool compareScannerLevels(const std::string &source, std::string &mismatch);
+
+// Write the source to a temporary file and read it back with LineReader,
+// using tiny blocks so lines cross block boundaries, at every scanner level.
+// Returns false unless it yields exactly the lines BufferLines does.
+bool compareLineReader(const std::string &source, std::string &mismatch);
+
+#endif // DIFFERENTIAL_H
@@ -0,0 +1,58 @@
+// fuzz_assembler.cpp
+//
+// libFuzzer target over the tokenizer, pass one and pass two. Every input is
+// assembled in memory with the scalar scanner and with the vectorized ones;
+// a crash, a sanitizer report or any difference between their outputs is a
+// finding.
+//
+//   clang++ -g -O1 -fsanitize=fuzzer,address,undefined -pthread -o fuzz_assembler fuzz_assembler.cpp differential.cpp ../assembler.cpp ../opcode.cpp ../symtab.cpp ../listing.cpp ../pipeline.cpp ../scanner.cpp ../hexutil.cpp ../symindex.cpp
+//   ./fuzz_assembler -max_len=4096 corpus/
+//
+// Without libFuzzer, build with -DFUZZ_STANDALONE (any compiler) to replay
+// inputs given as files on the command line.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "differential.h"
+#include "../assembler.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    std::string source(reinterpret_cast<const char *>(data), size);
+
+    // The tokenizer on its own: it never produces an empty token
+    std::vector<std::string> tokens;
+    tokenize(source, tokens);
+    for (const auto &token : tokens)
+    {
+        if (token.empty())
+            std::abort();
+    }
+
+    std::string mismatch;
+    if (!compareScannerLevels(source, mismatch))
+    {
+        std::fprintf(stderr, "%s\n", mismatch.c_str());
+        std::abort();
+    }
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+#include <fstream>
+#include <iterator>
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::ifstream input(argv[i], std::ios::binary);
+        std::string source((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(source.data()), source.size());
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,22 @@
+// hexutil.cpp
+#include "hexutil.h"
+
+// Convert integer to hexadecimal string with leading zeros
+std::string intToHex(int value, int width)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    char text[8];
+    unsigned int bits = static_cast<unsigned int>(value);
+    int length = 0;
+    do
+    {
+        text[7 - length++] = digits[bits & 0xF];
+        bits >>= 4;
+    } while (bits != 0);
+
+    std::string result;
+    if (length < width)
+        result.assign(width - length, '0');
+    result.append(text + 8 - length, length);
+    return result;
+}
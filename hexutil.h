@@ -0,0 +1,10 @@
+// hexutil.h
+#ifndef HEXUTIL_H
+#define HEXUTIL_H
+
+#include <string>
+
+// Uppercase hexadecimal with leading zeros to at least 'width' digits
+std::string intToHex(int value, int width);
+
+#endif // HEXUTIL_H
@@ -0,0 +1,103 @@
+// listing.cpp
+#include "listing.h"
+#include "hexutil.h"
+
+static const size_t bufferLimit = 64 * 1024;
+
+Listing::Listing(TextSink &out, const std::vector<std::string> &sourceLines)
+    : out(out), sourceLines(sourceLines)
+{
+    buffer.reserve(bufferLimit + 256);
+    buffer += "Line  Loc     Object code   Source statement\n\n";
+}
+
+void Listing::beginLine(int sourceIndex, const std::string &address)
+{
+    writePending();
+    pendingIndex = sourceIndex;
+    pendingAddress = address;
+    pendingObjectCode.clear();
+}
+
+void Listing::setObjectCode(const std::string &objectCode)
+{
+    pendingObjectCode = objectCode;
+}
+
+void Listing::finish(const Symtab &symtab)
+{
+    writePending();
+    // Source lines after the last statement (e.g. trailing comments)
+    while (nextSourceIndex < static_cast<int>(sourceLines.size()))
+    {
+        writeSource(nextSourceIndex, "", "");
+    }
+
+    buffer += "\nCross-reference table\n\n";
+    buffer += "Symbol    Address  Defined  References\n";
+    for (const auto &entry : symtab.sortedByName())
+    {
+        std::string defined = std::to_string(entry.definitionLine);
+        buffer += *entry.name;
+        buffer.append(entry.name->length() < 10 ? 10 - entry.name->length() : 1, ' ');
+        buffer += intToHex(entry.address, 6);
+        buffer += "   ";
+        buffer += defined;
+        const std::vector<int> &refs = *entry.references;
+        if (!refs.empty())
+            buffer.append(defined.length() < 9 ? 9 - defined.length() : 1, ' ');
+        for (size_t i = 0; i < refs.size(); ++i)
+        {
+            if (i)
+                buffer += ' ';
+            buffer += std::to_string(refs[i]);
+        }
+        buffer += '\n';
+        if (buffer.size() >= bufferLimit)
+            flush();
+    }
+
+    flush();
+}
+
+void Listing::writePending()
+{
+    if (pendingIndex < 0)
+        return;
+
+    // Comment and blank lines skipped by pass one come out before the statement
+    while (nextSourceIndex < pendingIndex)
+    {
+        writeSource(nextSourceIndex, "", "");
+    }
+    writeSource(pendingIndex, pendingAddress, pendingObjectCode);
+    pendingIndex = -1;
+}
+
+void Listing::writeSource(int sourceIndex, const std::string &address, const std::string &objectCode)
+{
+    std::string lineNo = std::to_string(sourceIndex + 1);
+    if (lineNo.length() < 4)
+        buffer.append(4 - lineNo.length(), ' ');
+    buffer += lineNo;
+    buffer += "  ";
+    buffer += address.empty() ? std::string(6, ' ') : address;
+    buffer += "  ";
+    buffer += objectCode;
+    if (objectCode.length() < 12)
+        buffer.append(12 - objectCode.length(), ' ');
+    buffer += "  ";
+    buffer += sourceLines[sourceIndex];
+    buffer += '\n';
+
+    nextSourceIndex = sourceIndex + 1;
+    if (buffer.size() >= bufferLimit)
+        flush();
+}
+
+void Listing::flush()
+{
+    out.write(std::move(buffer));
+    buffer = std::string();
+    buffer.reserve(bufferLimit + 256);
+}
@@ -0,0 +1,40 @@
+// listing.h
+#ifndef LISTING_H
+#define LISTING_H
+
+#include <string>
+#include <vector>
+#include "pipeline.h"
+#include "symtab.h"
+
+// Assembler listing written alongside pass two: line number, address,
+// object code and the original source statement, followed by a sorted
+// cross-reference table. Output is collected in a buffer and handed to
+// the sink (normally a writer thread) in large blocks instead of once per line.
+class Listing
+{
+public:
+    Listing(TextSink &out, const std::vector<std::string> &sourceLines);
+
+    // Start the listing entry for a source line; the previous entry is written out
+    void beginLine(int sourceIndex, const std::string &address);
+    void setObjectCode(const std::string &objectCode);
+
+    // Write the remaining source lines and the cross-reference table
+    void finish(const Symtab &symtab);
+
+private:
+    void writePending();
+    void writeSource(int sourceIndex, const std::string &address, const std::string &objectCode);
+    void flush();
+
+    TextSink &out;
+    const std::vector<std::string> &sourceLines;
+    std::string buffer;
+    int nextSourceIndex = 0;
+    int pendingIndex = -1;
+    std::string pendingAddress;
+    std::string pendingObjectCode;
+};
+
+#endif // LISTING_H
@@ -0,0 +1,140 @@
+// pipeline.cpp
+#include "pipeline.h"
+#include <iostream>
+#include <vector>
+#include "scanner.h"
+
+static const size_t queueCapacity = 1024;
+
+LineReader::LineReader(const std::string &filename, size_t blockSize)
+    : file(filename), blockSize(blockSize > 0 ? blockSize : 1), queue(queueCapacity)
+{
+    opened = file.is_open();
+    if (!opened)
+    {
+        queue.close();
+        return;
+    }
+    worker = std::thread(&LineReader::run, this);
+}
+
+LineReader::~LineReader()
+{
+    // Drain the queue so the reader thread is never left waiting on a full queue
+    std::string line;
+    while (next(line))
+    {
+    }
+    if (worker.joinable())
+        worker.join();
+}
+
+bool LineReader::isOpen() const
+{
+    return opened;
+}
+
+bool LineReader::next(std::string &line)
+{
+    return queue.popWait(line);
+}
+
+void LineReader::run()
+{
+    // Read large blocks and split them at line breaks found by the scanner,
+    // rather than calling getline once per line
+    std::vector<char> block(blockSize);
+    std::string line;
+    while (file)
+    {
+        file.read(block.data(), block.size());
+        size_t got = static_cast<size_t>(file.gcount());
+        size_t pos = 0;
+        while (pos < got)
+        {
+            size_t lineEnd = pos + scanFindChar(block.data() + pos, got - pos, '\n');
+            line.append(block.data() + pos, lineEnd - pos);
+            if (lineEnd == got)
+                break; // the line continues in the next block
+            queue.pushWait(line);
+            line.clear();
+            pos = lineEnd + 1;
+        }
+    }
+    // Last line without a trailing newline
+    if (!line.empty())
+    {
+        queue.pushWait(line);
+    }
+    file.close();
+    queue.close();
+}
+
+AsyncWriter::AsyncWriter(const std::string &filename)
+    : file(filename, std::ios::binary), queue(queueCapacity)
+{
+    if (!file.is_open())
+        return;
+    worker = std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    close();
+}
+
+bool AsyncWriter::isOpen() const
+{
+    return file.is_open();
+}
+
+void AsyncWriter::write(std::string text)
+{
+    if (!worker.joinable())
+        return;
+    queue.pushWait(text);
+}
+
+void AsyncWriter::close()
+{
+    if (!worker.joinable())
+        return;
+    queue.close();
+    worker.join();
+    file.close();
+}
+
+void AsyncWriter::run()
+{
+    std::string text;
+    while (queue.popWait(text))
+    {
+        file.write(text.data(), text.size());
+    }
+}
+
+BufferLines::BufferLines(const std::string &text)
+    : text(text)
+{
+}
+
+bool BufferLines::next(std::string &line)
+{
+    if (pos >= text.length())
+        return false;
+
+    size_t lineEnd = pos + scanFindChar(text.data() + pos, text.length() - pos, '\n');
+    line.assign(text, pos, lineEnd - pos);
+    pos = lineEnd + 1;
+    return true;
+}
+
+StringSink::StringSink(std::string &text)
+    : target(text)
+{
+}
+
+void StringSink::write(std::string text)
+{
+    target += text;
+}
@@ -0,0 +1,100 @@
+// pipeline.h
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <string>
+#include <fstream>
+#include <thread>
+#include "ringbuffer.h"
+
+// Pipeline stages that move file I/O off the assembling thread. Each is
+// connected to its caller by a RingBuffer, so reads and writes overlap
+// with tokenizing and encoding; a stage with nothing to do sleeps.
+
+// Where pass one gets its lines and where every output file goes
+class LineSource
+{
+public:
+    virtual ~LineSource() = default;
+    // Next line, without its line break; false once the input is exhausted
+    virtual bool next(std::string &line) = 0;
+};
+
+class TextSink
+{
+public:
+    virtual ~TextSink() = default;
+    virtual void write(std::string text) = 0;
+};
+
+// Reads a file line by line on its own thread
+class LineReader : public LineSource
+{
+public:
+    static const size_t defaultBlockSize = 64 * 1024;
+
+    // The file is read blockSize bytes at a time; small blocks are only
+    // useful for testing lines that span blocks
+    explicit LineReader(const std::string &filename, size_t blockSize = defaultBlockSize);
+    ~LineReader();
+
+    bool isOpen() const;
+    bool next(std::string &line) override;
+
+private:
+    void run();
+
+    std::ifstream file;
+    bool opened = false; // the reader thread closes file when it is done
+    size_t blockSize;
+    RingBuffer<std::string> queue;
+    std::thread worker;
+};
+
+// Writes text to a file on its own thread, in the order it was queued
+class AsyncWriter : public TextSink
+{
+public:
+    explicit AsyncWriter(const std::string &filename);
+    ~AsyncWriter();
+
+    bool isOpen() const;
+    void write(std::string text) override;
+    // Wait until everything queued so far is on disk, then close the file
+    void close();
+
+private:
+    void run();
+
+    std::ofstream file;
+    RingBuffer<std::string> queue;
+    std::thread worker;
+};
+
+// In-memory counterparts, for assembling a buffer without touching the
+// disk (fuzzing and differential checks)
+
+// Splits a buffer into lines the same way LineReader splits a file
+class BufferLines : public LineSource
+{
+public:
+    explicit BufferLines(const std::string &text);
+    bool next(std::string &line) override;
+
+private:
+    const std::string &text;
+    size_t pos = 0;
+};
+
+// Appends everything written to a string
+class StringSink : public TextSink
+{
+public:
+    explicit StringSink(std::string &text);
+    void write(std::string text) override;
+
+private:
+    std::string &target;
+};
+
+#endif // PIPELINE_H
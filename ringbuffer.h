@@ -0,0 +1,139 @@
+// ringbuffer.h
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+// Bounded single-producer/single-consumer queue. One thread may push and
+// one other thread may pop, without locks. Capacity is rounded up to a
+// power of two.
+//
+// pushWait/popWait block instead of failing. A waiting thread yields a few
+// times, then sleeps on a condition variable; the other side only takes the mutex to wake it, and
+// only when it has announced that it is waiting, so a busy queue never locks.
+template <typename T>
+class RingBuffer
+{
+public:
+    explicit RingBuffer(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size *= 2;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    // Producer side: false if the queue is full (item is left untouched)
+    bool push(T &item)
+    {
+        size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - headIndex.load(std::memory_order_acquire) == slots.size())
+            return false;
+        slots[tail & mask] = std::move(item);
+        tailIndex.store(tail + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    // Consumer side: false if the queue is empty
+    bool pop(T &item)
+    {
+        size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire))
+            return false;
+        item = std::move(slots[head & mask]);
+        headIndex.store(head + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    // Producer side: push, sleeping while the queue is full
+    void pushWait(T &item)
+    {
+        for (int spins = 0; !push(item); ++spins)
+        {
+            if (spins < spinLimit)
+                std::this_thread::yield();
+            else
+                park(producerWaiting, [this]
+                     { return !full(); });
+        }
+        wake(consumerWaiting);
+    }
+
+    // Consumer side: pop, sleeping while the queue is empty; false once
+    // close() has been called and everything pushed before it was popped
+    bool popWait(T &item)
+    {
+        for (int spins = 0; !pop(item); ++spins)
+        {
+            if (closed.load(std::memory_order_acquire))
+                return pop(item);
+            if (spins < spinLimit)
+                std::this_thread::yield();
+            else
+                park(consumerWaiting, [this]
+                     { return !empty() || closed.load(std::memory_order_acquire); });
+        }
+        wake(producerWaiting);
+        return true;
+    }
+
+    // Producer side: no more items will be pushed
+    void close()
+    {
+        closed.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(parkMutex);
+        wakeup.notify_all();
+    }
+
+private:
+    static const int spinLimit = 16; // yields before a waiting thread sleeps
+
+    bool empty() const
+    {
+        return headIndex.load(std::memory_order_seq_cst) == tailIndex.load(std::memory_order_seq_cst);
+    }
+
+    bool full() const
+    {
+        return tailIndex.load(std::memory_order_seq_cst) - headIndex.load(std::memory_order_seq_cst) == slots.size();
+    }
+
+    // Announce the wait, then re-check under the mutex. The flag and the
+    // indices are all sequentially consistent, so either the waiter sees the
+    // other side's update or the other side sees the flag and wakes it
+    template <typename Ready>
+    void park(std::atomic<bool> &waiting, Ready ready)
+    {
+        std::unique_lock<std::mutex> lock(parkMutex);
+        waiting.store(true, std::memory_order_seq_cst);
+        wakeup.wait(lock, ready);
+        waiting.store(false, std::memory_order_relaxed);
+    }
+
+    void wake(std::atomic<bool> &waiting)
+    {
+        if (waiting.load(std::memory_order_seq_cst))
+        {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            wakeup.notify_all();
+        }
+    }
+
+    std::vector<T> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> headIndex{0};
+    alignas(64) std::atomic<size_t> tailIndex{0};
+    std::atomic<bool> closed{false};
+    std::atomic<bool> producerWaiting{false};
+    std::atomic<bool> consumerWaiting{false};
+    std::mutex parkMutex;
+    std::condition_variable wakeup;
+};
+
+#endif // RINGBUFFER_H
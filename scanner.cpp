@@ -0,0 +1,370 @@
+// scanner.cpp
+#include "scanner.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+enum ScanLevel
+{
+    LevelScalar,
+    LevelSse2,
+    LevelAvx2
+};
+
+// Space: anything isspace accepts. Exact: one given character.
+enum CharClass
+{
+    Space,
+    Exact
+};
+
+static ScanLevel supportedLevel()
+{
+    ScanLevel best = LevelScalar;
+#ifdef SCANNER_X86
+    best = LevelSse2;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        best = LevelAvx2;
+#endif
+    return best;
+}
+
+// Level for a name, capped at what the CPU supports; false for an unknown name
+static bool levelByName(const char *name, ScanLevel &level)
+{
+    static const ScanLevel best = supportedLevel();
+    if (std::strcmp(name, "scalar") == 0)
+        level = LevelScalar;
+    else if (std::strcmp(name, "sse2") == 0)
+        level = LevelSse2 < best ? LevelSse2 : best;
+    else if (std::strcmp(name, "avx2") == 0)
+        level = best;
+    else
+        return false;
+    return true;
+}
+
+// The best supported level, unless SIC_SCANNER asks for a lower one
+static int initialLevel()
+{
+    ScanLevel level = supportedLevel();
+    const char *forced = std::getenv("SIC_SCANNER");
+    if (forced != nullptr)
+        levelByName(forced, level);
+    return level;
+}
+
+static std::atomic<int> &levelSetting()
+{
+    static std::atomic<int> level(initialLevel());
+    return level;
+}
+
+static ScanLevel currentLevel()
+{
+    return static_cast<ScanLevel>(levelSetting().load(std::memory_order_relaxed));
+}
+
+bool setScannerLevel(const char *name)
+{
+    ScanLevel level;
+    if (!levelByName(name, level))
+        return false;
+    levelSetting().store(level, std::memory_order_relaxed);
+    return true;
+}
+
+// ---- Scalar versions, also used for the tail of each vector loop ----
+
+static bool inClass(unsigned char ch, CharClass cls, char c)
+{
+    switch (cls)
+    {
+    case Space:
+        return ch == ' ' || (ch >= '\t' && ch <= '\r');
+    default:
+        return ch == static_cast<unsigned char>(c);
+    }
+}
+
+// First position from 'from' whose membership in the class equals 'match'
+static size_t findScalar(const char *data, size_t from, size_t length, CharClass cls, char c, bool match)
+{
+    for (size_t i = from; i < length; ++i)
+    {
+        if (inClass(data[i], cls, c) == match)
+            return i;
+    }
+    return length;
+}
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+static void hexScalar(const char *data, size_t length, char *dst)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        unsigned char byte = static_cast<unsigned char>(data[i]);
+        dst[2 * i] = hexDigits[byte >> 4];
+        dst[2 * i + 1] = hexDigits[byte & 0x0F];
+    }
+}
+
+static bool normalizeHexScalar(const char *data, size_t length, char *dst)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        char ch = data[i];
+        if (ch >= '0' && ch <= '9')
+            dst[i] = ch;
+        else if ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'f')
+            dst[i] = static_cast<char>(ch & ~0x20);
+        else
+            return false;
+    }
+    return true;
+}
+
+#ifdef SCANNER_X86
+
+// ---- SSE2: 16 characters at a time ----
+
+// Bytes in 'from'..'from'+'count' (unsigned); SSE2 has no unsigned compare
+static inline __m128i inRange128(__m128i v, char from, char count)
+{
+    __m128i x = _mm_sub_epi8(v, _mm_set1_epi8(from));
+    return _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(count)), x);
+}
+
+static inline __m128i classMask128(__m128i v, CharClass cls, char c)
+{
+    if (cls == Exact)
+        return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+    __m128i spaces = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    return _mm_or_si128(spaces, inRange128(v, '\t', '\r' - '\t'));
+}
+
+static size_t findSse2(const char *data, size_t length, CharClass cls, char c, bool match)
+{
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(classMask128(v, cls, c)));
+        if (!match)
+            bits = ~bits & 0xFFFF;
+        if (bits != 0)
+            return i + __builtin_ctz(bits);
+    }
+    return findScalar(data, i, length, cls, c, match);
+}
+
+// Nibble values 0..15 to '0'..'9', 'A'..'F'
+static inline __m128i nibblesToAscii128(__m128i n)
+{
+    __m128i letters = _mm_cmpgt_epi8(n, _mm_set1_epi8(9));
+    __m128i ascii = _mm_add_epi8(n, _mm_set1_epi8('0'));
+    return _mm_add_epi8(ascii, _mm_and_si128(letters, _mm_set1_epi8('A' - '0' - 10)));
+}
+
+static void hexSse2(const char *data, size_t length, char *dst)
+{
+    const __m128i lowNibble = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), lowNibble);
+        __m128i lo = _mm_and_si128(v, lowNibble);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i), nibblesToAscii128(_mm_unpacklo_epi8(hi, lo)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i + 16), nibblesToAscii128(_mm_unpackhi_epi8(hi, lo)));
+    }
+    hexScalar(data + i, length - i, dst + 2 * i);
+}
+
+static bool normalizeHexSse2(const char *data, size_t length, char *dst)
+{
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i digits = inRange128(v, '0', 9);
+        __m128i letters = inRange128(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 5);
+        if (_mm_movemask_epi8(_mm_or_si128(digits, letters)) != 0xFFFF)
+            return false;
+        __m128i upper = _mm_andnot_si128(_mm_and_si128(letters, _mm_set1_epi8(0x20)), v);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), upper);
+    }
+    return normalizeHexScalar(data + i, length - i, dst + i);
+}
+
+// ---- AVX2: 32 characters at a time, compiled for AVX2 only in these functions ----
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static inline __m256i inRange256(__m256i v, char from, char count)
+{
+    __m256i x = _mm256_sub_epi8(v, _mm256_set1_epi8(from));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(count)), x);
+}
+
+AVX2_TARGET static inline __m256i classMask256(__m256i v, CharClass cls, char c)
+{
+    if (cls == Exact)
+        return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+    __m256i spaces = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    return _mm256_or_si256(spaces, inRange256(v, '\t', '\r' - '\t'));
+}
+
+AVX2_TARGET static size_t findAvx2(const char *data, size_t length, CharClass cls, char c, bool match)
+{
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(classMask256(v, cls, c)));
+        if (!match)
+            bits = ~bits;
+        if (bits != 0)
+            return i + __builtin_ctz(bits);
+    }
+    return findScalar(data, i, length, cls, c, match);
+}
+
+AVX2_TARGET static inline __m256i nibblesToAscii256(__m256i n)
+{
+    __m256i letters = _mm256_cmpgt_epi8(n, _mm256_set1_epi8(9));
+    __m256i ascii = _mm256_add_epi8(n, _mm256_set1_epi8('0'));
+    return _mm256_add_epi8(ascii, _mm256_and_si256(letters, _mm256_set1_epi8('A' - '0' - 10)));
+}
+
+AVX2_TARGET static void hexAvx2(const char *data, size_t length, char *dst)
+{
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        // Unpacking works within 128-bit lanes, so first put bytes 0-15 in the
+        // low halves of the lanes and bytes 16-31 in the high halves
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        v = _mm256_permute4x64_epi64(v, 0xD8);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble);
+        __m256i lo = _mm256_and_si256(v, lowNibble);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i), nibblesToAscii256(_mm256_unpacklo_epi8(hi, lo)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i + 32), nibblesToAscii256(_mm256_unpackhi_epi8(hi, lo)));
+    }
+    hexSse2(data + i, length - i, dst + 2 * i);
+}
+
+AVX2_TARGET static bool normalizeHexAvx2(const char *data, size_t length, char *dst)
+{
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i digits = inRange256(v, '0', 9);
+        __m256i letters = inRange256(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 5);
+        if (_mm256_movemask_epi8(_mm256_or_si256(digits, letters)) != -1)
+            return false;
+        __m256i upper = _mm256_andnot_si256(_mm256_and_si256(letters, _mm256_set1_epi8(0x20)), v);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), upper);
+    }
+    return normalizeHexSse2(data + i, length - i, dst + i);
+}
+
+#endif // SCANNER_X86
+
+// ---- Dispatch ----
+
+static size_t find(const char *data, size_t length, CharClass cls, char c, bool match)
+{
+    switch (currentLevel())
+    {
+#ifdef SCANNER_X86
+    case LevelAvx2:
+        return findAvx2(data, length, cls, c, match);
+    case LevelSse2:
+        return findSse2(data, length, cls, c, match);
+#endif
+    default:
+        return findScalar(data, 0, length, cls, c, match);
+    }
+}
+
+size_t scanFindSpace(const char *data, size_t length)
+{
+    return find(data, length, Space, 0, true);
+}
+
+size_t scanSkipSpace(const char *data, size_t length)
+{
+    return find(data, length, Space, 0, false);
+}
+
+size_t scanFindChar(const char *data, size_t length, char c)
+{
+    return find(data, length, Exact, c, true);
+}
+
+void bytesToHex(const char *data, size_t length, std::string &out)
+{
+    size_t start = out.size();
+    out.resize(start + 2 * length);
+    char *dst = &out[0] + start;
+    switch (currentLevel())
+    {
+#ifdef SCANNER_X86
+    case LevelAvx2:
+        hexAvx2(data, length, dst);
+        break;
+    case LevelSse2:
+        hexSse2(data, length, dst);
+        break;
+#endif
+    default:
+        hexScalar(data, length, dst);
+    }
+}
+
+bool normalizeHex(const char *data, size_t length, std::string &out)
+{
+    size_t start = out.size();
+    out.resize(start + length);
+    char *dst = &out[0] + start;
+    bool valid;
+    switch (currentLevel())
+    {
+#ifdef SCANNER_X86
+    case LevelAvx2:
+        valid = normalizeHexAvx2(data, length, dst);
+        break;
+    case LevelSse2:
+        valid = normalizeHexSse2(data, length, dst);
+        break;
+#endif
+    default:
+        valid = normalizeHexScalar(data, length, dst);
+    }
+    if (!valid)
+        out.resize(start);
+    return valid;
+}
+
+const char *scannerLevel()
+{
+    switch (currentLevel())
+    {
+    case LevelAvx2:
+        return "avx2";
+    case LevelSse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
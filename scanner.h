@@ -0,0 +1,30 @@
+// scanner.h
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <string>
+#include <cstddef>
+
+// Character scanning used by the tokenizer and the BYTE encoder. Each
+// function has SSE2 and AVX2 versions with a scalar fallback; the best one
+// the CPU supports is picked at run time. Setting SIC_SCANNER to "scalar",
+// "sse2" or "avx2" forces a lower level, e.g. to compare against scalar.
+
+// Position of the first (non-)whitespace character, as in isspace (length if none)
+size_t scanFindSpace(const char *data, size_t length);
+size_t scanSkipSpace(const char *data, size_t length);
+// Position of the first occurrence of c (length if none)
+size_t scanFindChar(const char *data, size_t length, char c);
+
+// Append two uppercase hex digits per byte to out
+void bytesToHex(const char *data, size_t length, std::string &out);
+// Append the hex digits, uppercased, to out; false if any is not a hex digit
+bool normalizeHex(const char *data, size_t length, std::string &out);
+
+// Name of the level in use: "avx2", "sse2" or "scalar"
+const char *scannerLevel();
+// Switch level by name, capped at what the CPU supports; false for an
+// unknown name. Only change it while nothing is being assembled.
+bool setScannerLevel(const char *name);
+
+#endif // SCANNER_H
@@ -0,0 +1,138 @@
+// symindex.cpp
+#include "symindex.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+static const size_t headerSize = 20;
+static const size_t entrySize = 24;
+
+bool SymbolIndex::load(const std::string &filename)
+{
+    std::ifstream infile(filename, std::ios::binary);
+    if (!infile.is_open())
+    {
+        std::cerr << "Error: Cannot open symbol index file " << filename << std::endl;
+        return false;
+    }
+    std::string bytes((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+    return loadBuffer(bytes, filename);
+}
+
+bool SymbolIndex::loadBuffer(const std::string &bytes, const std::string &filename)
+{
+    data.assign(bytes.begin(), bytes.end());
+    count = 0;
+
+    if (data.size() < headerSize || std::string(data.begin(), data.begin() + 4) != "SYMX" || word(4) != 1)
+    {
+        std::cerr << "Error: " << filename << " is not a symbol index file." << std::endl;
+        return false;
+    }
+
+    uint32_t symbols = word(8);
+    uint32_t refCount = word(12);
+    uint32_t stringSize = word(16);
+    entriesOffset = headerSize;
+    byNameOffset = entriesOffset + size_t(symbols) * entrySize;
+    refsOffset = byNameOffset + size_t(symbols) * 4;
+    stringsOffset = refsOffset + size_t(refCount) * 4;
+    if (stringsOffset + stringSize != data.size())
+    {
+        std::cerr << "Error: Symbol index file " << filename << " is truncated." << std::endl;
+        return false;
+    }
+
+    // Check every entry once here so lookups can trust the offsets
+    for (uint32_t i = 0; i < symbols; ++i)
+    {
+        size_t entry = entriesOffset + size_t(i) * entrySize;
+        if (size_t(word(entry + 4)) + word(entry + 8) > stringSize ||
+            size_t(word(entry + 16)) + word(entry + 20) > refCount ||
+            word(byNameOffset + size_t(i) * 4) >= symbols)
+        {
+            std::cerr << "Error: Symbol index file " << filename << " is corrupt." << std::endl;
+            return false;
+        }
+    }
+
+    count = symbols;
+    return true;
+}
+
+size_t SymbolIndex::size() const
+{
+    return count;
+}
+
+bool SymbolIndex::findByAddress(int address, Symbol &symbol) const
+{
+    // Entries are in address order: find the last one at or below the address
+    uint32_t low = 0, high = count;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        if (static_cast<int>(entryField(mid, 0)) <= address)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if (low == 0)
+        return false;
+
+    readEntry(low - 1, symbol);
+    return true;
+}
+
+bool SymbolIndex::findByName(const std::string &name, Symbol &symbol) const
+{
+    uint32_t low = 0, high = count;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t entry = word(byNameOffset + size_t(mid) * 4);
+        int cmp = entryName(entry).compare(name);
+        if (cmp == 0)
+        {
+            readEntry(entry, symbol);
+            return true;
+        }
+        if (cmp < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return false;
+}
+
+uint32_t SymbolIndex::word(size_t offset) const
+{
+    return uint32_t(data[offset]) | (uint32_t(data[offset + 1]) << 8) |
+           (uint32_t(data[offset + 2]) << 16) | (uint32_t(data[offset + 3]) << 24);
+}
+
+// Fields: 0 address, 1 name offset, 2 name length, 3 definition line, 4 first reference, 5 reference count
+uint32_t SymbolIndex::entryField(uint32_t entry, int field) const
+{
+    return word(entriesOffset + size_t(entry) * entrySize + size_t(field) * 4);
+}
+
+std::string SymbolIndex::entryName(uint32_t entry) const
+{
+    const unsigned char *start = data.data() + stringsOffset + entryField(entry, 1);
+    return std::string(start, start + entryField(entry, 2));
+}
+
+void SymbolIndex::readEntry(uint32_t entry, Symbol &symbol) const
+{
+    symbol.name = entryName(entry);
+    symbol.address = static_cast<int>(entryField(entry, 0));
+    symbol.definitionLine = static_cast<int>(entryField(entry, 3));
+    symbol.references.clear();
+    uint32_t first = entryField(entry, 4);
+    uint32_t refs = entryField(entry, 5);
+    for (uint32_t i = 0; i < refs; ++i)
+    {
+        symbol.references.push_back(static_cast<int>(word(refsOffset + size_t(first + i) * 4)));
+    }
+}
@@ -0,0 +1,45 @@
+// symindex.h
+#ifndef SYMINDEX_H
+#define SYMINDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Read-only view of a symbol index produced by Symtab::formatIndex.
+// The file is already sorted, so lookups are binary searches over it.
+class SymbolIndex
+{
+public:
+    struct Symbol
+    {
+        std::string name;
+        int address;
+        int definitionLine;
+        std::vector<int> references;
+    };
+
+    bool load(const std::string &filename);
+    // Same as load, for an index already in memory; filename is only used in messages
+    bool loadBuffer(const std::string &bytes, const std::string &filename = "<buffer>");
+    size_t size() const;
+
+    // Symbol with the highest address not above the given one
+    bool findByAddress(int address, Symbol &symbol) const;
+    bool findByName(const std::string &name, Symbol &symbol) const;
+
+private:
+    uint32_t word(size_t offset) const;
+    uint32_t entryField(uint32_t entry, int field) const;
+    std::string entryName(uint32_t entry) const;
+    void readEntry(uint32_t entry, Symbol &symbol) const;
+
+    std::vector<unsigned char> data;
+    uint32_t count = 0;
+    size_t entriesOffset = 0;
+    size_t byNameOffset = 0;
+    size_t refsOffset = 0;
+    size_t stringsOffset = 0;
+};
+
+#endif // SYMINDEX_H
@@ -1,11 +1,16 @@
 // symtab.cpp
 #include "symtab.h"
-#include <fstream>
-#include <iostream>
+#include "hexutil.h"
+#include <algorithm>
+#include <sstream>
+#include <cstdint>
 
-void Symtab::addSymbol(const std::string &symbol, int address)
+void Symtab::addSymbol(const std::string &symbol, int address, int line)
 {
-    symbolMap[symbol] = address;
+    SymbolInfo &info = symbolMap[symbol];
+    info.address = address;
+    info.definitionLine = line;
+    sorted = false;
 }
 
 bool Symtab::contains(const std::string &symbol) const
@@ -18,7 +23,7 @@ int Symtab::getAddress(const std::string &symbol) const
     auto it = symbolMap.find(symbol);
     if (it != symbolMap.end())
     {
-        return it->second;
+        return it->second.address;
     }
     else
     {
@@ -26,19 +31,150 @@ int Symtab::getAddress(const std::string &symbol) const
     }
 }
 
-void Symtab::writeToFile(const std::string &filename) const
+void Symtab::addReference(const std::string &symbol, int line)
 {
-    std::ofstream outfile(filename);
-    if (!outfile.is_open())
+    auto it = symbolMap.find(symbol);
+    if (it != symbolMap.end())
     {
-        std::cerr << "Error: Cannot open symbol table file " << filename << " for writing." << std::endl;
-        return;
+        it->second.references.push_back(line);
     }
+}
+
+const std::vector<Symtab::SymbolEntry> &Symtab::sortedByName() const
+{
+    sortSymbols();
+    return byName;
+}
+
+const std::vector<Symtab::SymbolEntry> &Symtab::sortedByAddress() const
+{
+    sortSymbols();
+    return byAddress;
+}
+
+// Sort by name once, then stably by address so equal addresses stay in name order
+void Symtab::sortSymbols() const
+{
+    if (sorted)
+        return;
 
+    byName.clear();
+    byName.reserve(symbolMap.size());
     for (const auto &entry : symbolMap)
     {
-        outfile << entry.first << " " << std::hex << entry.second << std::dec << std::endl;
+        byName.push_back({&entry.first, entry.second.address, entry.second.definitionLine,
+                          &entry.second.references, 0});
+    }
+    std::sort(byName.begin(), byName.end(), [](const SymbolEntry &a, const SymbolEntry &b)
+              { return *a.name < *b.name; });
+
+    // Remember each symbol's name position so its address position can be filled in
+    for (size_t i = 0; i < byName.size(); ++i)
+    {
+        byName[i].addressIndex = static_cast<unsigned int>(i);
+    }
+    byAddress = byName;
+    std::stable_sort(byAddress.begin(), byAddress.end(), [](const SymbolEntry &a, const SymbolEntry &b)
+                     { return a.address < b.address; });
+    for (size_t i = 0; i < byAddress.size(); ++i)
+    {
+        byName[byAddress[i].addressIndex].addressIndex = static_cast<unsigned int>(i);
+        byAddress[i].addressIndex = static_cast<unsigned int>(i);
+    }
+
+    sorted = true;
+}
+
+// Contents of the symbol table file: one "NAME address" line per symbol, by name
+std::string Symtab::formatTable() const
+{
+    std::stringstream ss;
+    ss << std::hex;
+    for (const auto &entry : sortedByName())
+    {
+        ss << *entry.name << " " << entry.address << "\n";
+    }
+    return ss.str();
+}
+
+std::string Symtab::formatSortedText() const
+{
+    std::string text;
+    auto writeSection = [&](const char *title, const std::vector<SymbolEntry> &entries)
+    {
+        text += title;
+        text += "\n";
+        for (const auto &entry : entries)
+        {
+            text += intToHex(entry.address, 6);
+            text += " ";
+            text += *entry.name;
+            if (entry.name->length() < 8)
+                text.append(8 - entry.name->length(), ' ');
+            text += " ";
+            text += std::to_string(entry.definitionLine);
+            for (int line : *entry.references)
+            {
+                text += " ";
+                text += std::to_string(line);
+            }
+            text += "\n";
+        }
+    };
+    writeSection("BY NAME", sortedByName());
+    text += "\n";
+    writeSection("BY ADDRESS", sortedByAddress());
+    return text;
+}
+
+// Index file layout (all fields 32-bit little endian):
+//   header:   "SYMX", version, symbol count, reference count, string table size
+//   entries:  address, name offset, name length, definition line,
+//             first reference, reference count -- sorted by address
+//   by name:  entry numbers sorted by symbol name
+//   refs:     use-site line numbers
+//   strings:  symbol names, not terminated
+static void putWord(std::string &out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
     }
+}
+
+std::string Symtab::formatIndex() const
+{
+    const std::vector<SymbolEntry> &entriesByAddress = sortedByAddress();
+    std::string entries, strings, refs;
+    uint32_t refCount = 0;
 
-    outfile.close();
-}
\ No newline at end of file
+    for (const auto &entry : entriesByAddress)
+    {
+        putWord(entries, static_cast<uint32_t>(entry.address));
+        putWord(entries, static_cast<uint32_t>(strings.size()));
+        putWord(entries, static_cast<uint32_t>(entry.name->size()));
+        putWord(entries, static_cast<uint32_t>(entry.definitionLine));
+        putWord(entries, refCount);
+        putWord(entries, static_cast<uint32_t>(entry.references->size()));
+
+        strings += *entry.name;
+        for (int line : *entry.references)
+        {
+            putWord(refs, static_cast<uint32_t>(line));
+        }
+        refCount += static_cast<uint32_t>(entry.references->size());
+    }
+
+    std::string byNameTable;
+    for (const auto &entry : sortedByName())
+    {
+        putWord(byNameTable, entry.addressIndex);
+    }
+
+    std::string index = "SYMX";
+    putWord(index, 1);
+    putWord(index, static_cast<uint32_t>(entriesByAddress.size()));
+    putWord(index, refCount);
+    putWord(index, static_cast<uint32_t>(strings.size()));
+    return index + entries + byNameTable + refs + strings;
+}
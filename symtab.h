@@ -4,17 +4,51 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 class Symtab
 {
 public:
-    void addSymbol(const std::string &symbol, int address);
+    struct SymbolInfo
+    {
+        int address = 0;
+        int definitionLine = 0;      // source line of the definition
+        std::vector<int> references; // source lines of every use
+    };
+
+    // One symbol in a sorted view of the table; the pointers stay valid as
+    // references are added, so a view can be reused after pass two
+    struct SymbolEntry
+    {
+        const std::string *name;
+        int address;
+        int definitionLine;
+        const std::vector<int> *references;
+        unsigned int addressIndex; // position in sortedByAddress()
+    };
+
+    void addSymbol(const std::string &symbol, int address, int line = 0);
     bool contains(const std::string &symbol) const;
     int getAddress(const std::string &symbol) const;
-    void writeToFile(const std::string &filename) const;
+    void addReference(const std::string &symbol, int line);
+
+    // Views sorted by name, and by address with ties by name; built once
+    const std::vector<SymbolEntry> &sortedByName() const;
+    const std::vector<SymbolEntry> &sortedByAddress() const;
+
+    // File contents: the symbol table, a text cross-reference by name and
+    // by address, and a binary index that SymbolIndex can search
+    std::string formatTable() const;
+    std::string formatSortedText() const;
+    std::string formatIndex() const;
 
 private:
-    std::unordered_map<std::string, int> symbolMap;
+    void sortSymbols() const;
+
+    std::unordered_map<std::string, SymbolInfo> symbolMap;
+    mutable std::vector<SymbolEntry> byName;
+    mutable std::vector<SymbolEntry> byAddress;
+    mutable bool sorted = false;
 };
 
-#endif // SYMTAB_H
\ No newline at end of file
+#endif // SYMTAB_H